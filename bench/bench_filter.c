@@ -0,0 +1,71 @@
+// Negative lookups (ch_hash_contains on missing keys) with and without
+// the Bloom filter (ch_hash_set_filter)
+// Usage: bench_filter [num_keys ...]
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../chained_hash.h"
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench(size_t num_keys) {
+
+    ch_hash *hash = ch_hash_new(ch_key_ops_string, ch_val_ops_string);
+    char **misses;
+    char key[32];
+    size_t found;
+    double start;
+
+    for(size_t i = 0; i < num_keys; i++) {
+        sprintf(key, "key%zu", i);
+        ch_hash_put(hash, key, "v");
+    }
+
+    // The missing keys are prepared upfront, so only the lookups are timed
+    misses = malloc(num_keys * sizeof(*misses));
+    if (NULL == misses) {
+        fprintf(stderr,"malloc() failed in file %s at line # %d", __FILE__,__LINE__);
+        exit(EXIT_FAILURE);
+    }
+    for(size_t i = 0; i < num_keys; i++) {
+        sprintf(key, "miss%zu", i);
+        misses[i] = ch_string_cp(key, NULL);
+    }
+
+    for(int filter = 0; filter < 2; filter++) {
+        ch_hash_set_filter(hash, filter);
+        found = 0;
+        start = now();
+        for(size_t i = 0; i < num_keys; i++) {
+            found += ch_hash_contains(hash, misses[i]);
+        }
+        printf("keys=%-10zu filter=%-3s %8.1f ns/lookup (found=%zu)\n",
+            num_keys, filter ? "on" : "off", (now() - start) * 1e9 / num_keys, found);
+    }
+
+    for(size_t i = 0; i < num_keys; i++) {
+        free(misses[i]);
+    }
+    free(misses);
+    ch_hash_free(hash);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        // The largest size is well beyond a typical last level cache
+        bench(100000);
+        bench(4000000);
+        bench(16000000);
+    }
+    for(int i = 1; i < argc; i++) {
+        bench(strtoull(argv[i], NULL, 10));
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+// Average number of probed nodes per lookup on a Zipfian trace,
+// without and with self-organizing buckets (ch_table_set_reorder)
+// Usage: bench_reorder [num_keys [num_lookups [zipf_exponent]]]
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../ch_table.h"
+
+// xorshift64*, so the trace is the same on every platform
+static uint64_t rng_state = 42;
+
+static double rng_next(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (double) ((rng_state * 0x2545f4914f6cdd1dULL) >> 11) / (double) (1ULL << 53);
+}
+
+// Generates `num_lookups` key indexes following a Zipf distribution:
+// the key with rank r is drawn with a probability proportional to 1/r^s
+static size_t *zipf_trace(size_t num_keys, size_t num_lookups, double s) {
+
+    double *cdf;
+    size_t *trace;
+    double total = 0;
+    double u;
+    size_t lo, hi, mid;
+
+    cdf = malloc(num_keys * sizeof(*cdf));
+    trace = malloc(num_lookups * sizeof(*trace));
+    if (NULL == cdf || NULL == trace) {
+        fprintf(stderr,"malloc() failed in file %s at line # %d", __FILE__,__LINE__);
+        exit(EXIT_FAILURE);
+    }
+
+    for(size_t i = 0; i < num_keys; i++) {
+        total += 1.0 / pow((double) (i + 1), s);
+        cdf[i] = total;
+    }
+    for(size_t t = 0; t < num_lookups; t++) {
+        // Binary search of the rank
+        u = rng_next() * total;
+        lo = 0;
+        hi = num_keys - 1;
+        while(lo < hi) {
+            mid = lo + (hi - lo) / 2;
+            if (cdf[mid] < u) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        trace[t] = lo;
+    }
+
+    free(cdf);
+    return trace;
+}
+
+static void bench(ch_engine engine, ch_reorder mode, uint32_t rate,
+                  size_t num_keys, size_t *trace, size_t num_lookups) {
+
+    static const char *engines[] = { "list", "vect" };
+    static const char *modes[] = { "none", "move-to-front", "transpose" };
+    ch_table *table;
+    char key[32];
+    double probes = 0;
+
+    table = ch_table_new(engine, ch_key_ops_string, ch_val_ops_string);
+    for(size_t i = 0; i < num_keys; i++) {
+        // Hot keys are not inserted first (nor last)
+        sprintf(key, "key%zu", (size_t) ((i * 7919ULL) % num_keys));
+        ch_table_put(table, key, "v");
+    }
+    ch_table_set_reorder(table, mode, rate);
+
+    // The first half of the trace warms the table up,
+    // the second half is measured
+    for(size_t t = 0; t < num_lookups; t++) {
+        sprintf(key, "key%zu", trace[t]);
+        if (t >= num_lookups / 2) {
+            probes += ch_table_depth(table, key);
+        }
+        ch_table_get(table, key);
+    }
+
+    printf("%s %-14s rate=%-3" PRIu32 " avg probes=%.4f\n",
+        engines[engine], modes[mode], rate, probes / (num_lookups - num_lookups / 2));
+    ch_table_free(table);
+}
+
+int main(int argc, char *argv[]) {
+
+    size_t num_keys = (argc > 1) ? strtoull(argv[1], NULL, 10) : 1000000;
+    size_t num_lookups = (argc > 2) ? strtoull(argv[2], NULL, 10) : 4000000;
+    double s = (argc > 3) ? strtod(argv[3], NULL) : 1.0;
+    size_t *trace;
+
+    trace = zipf_trace(num_keys, num_lookups, s);
+
+    printf("keys=%zu lookups=%zu zipf_exponent=%.2f\n", num_keys, num_lookups, s);
+    for(int engine = CH_ENGINE_LIST; engine <= CH_ENGINE_VECT; engine++) {
+        bench(engine, CH_REORDER_NONE, 1, num_keys, trace, num_lookups);
+        for(int mode = CH_REORDER_MOVE_TO_FRONT; mode <= CH_REORDER_TRANSPOSE; mode++) {
+            bench(engine, mode, 1, num_keys, trace, num_lookups);
+            bench(engine, mode, 16, num_keys, trace, num_lookups);
+        }
+    }
+
+    free(trace);
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "ch_bloom.h"
+
+ch_bloom *ch_bloom_new(size_t capacity) {
+    ch_bloom *bloom;
+    size_t size;
+
+    bloom = malloc(sizeof(*bloom));
+    if (NULL == bloom) {
+        fprintf(stderr,"malloc() failed in file %s at line # %d", __FILE__,__LINE__);
+        exit(EXIT_FAILURE);
+    }
+
+    bloom->num_blocks = (capacity * CH_BLOOM_BITS_PER_KEY) / (CH_BLOOM_BLOCK_WORDS * 64) + 1;
+
+    // Blocks are aligned to cache lines
+    size = bloom->num_blocks * CH_BLOOM_BLOCK_WORDS * sizeof(*(bloom->blocks));
+    bloom->blocks = aligned_alloc(CH_BLOOM_BLOCK_WORDS * sizeof(*(bloom->blocks)), size);
+    if (NULL == bloom->blocks) {
+        fprintf(stderr,"aligned_alloc() failed in file %s at line # %d", __FILE__,__LINE__);
+        exit(EXIT_FAILURE);
+    }
+    memset(bloom->blocks, 0, size);
+
+    return bloom;
+}
+
+void ch_bloom_free(ch_bloom *bloom) {
+    free(bloom->blocks);
+    free(bloom);
+}
+
+// The block is picked with the high bits of the hash
+// (the table picks the bucket with the low bits)
+static uint64_t *ch_bloom_block(ch_bloom *bloom, uint32_t h) {
+    size_t idx = (size_t) (((uint64_t) h * bloom->num_blocks) >> 32);
+    return &bloom->blocks[idx * CH_BLOOM_BLOCK_WORDS];
+}
+
+void ch_bloom_add(ch_bloom *bloom, uint32_t h) {
+    uint64_t *block = ch_bloom_block(bloom, h);
+    uint32_t bit;
+    for(int i = 0; i < CH_BLOOM_NUM_BITS; i++) {
+        // Each round re-mixes the hash and uses its top 9 bits
+        // to pick one of the 512 bits of the block
+        h *= 0x9e3779b1U;
+        bit = h >> 23;
+        block[bit >> 6] |= (uint64_t) 1 << (bit & 63);
+    }
+}
+
+bool ch_bloom_maybe(ch_bloom *bloom, uint32_t h) {
+    uint64_t *block = ch_bloom_block(bloom, h);
+    uint32_t bit;
+    for(int i = 0; i < CH_BLOOM_NUM_BITS; i++) {
+        h *= 0x9e3779b1U;
+        bit = h >> 23;
+        if (!(block[bit >> 6] & ((uint64_t) 1 << (bit & 63)))) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,36 @@
+#ifndef CH_BLOOM_H
+#define CH_BLOOM_H
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Bits reserved for each element
+#define CH_BLOOM_BITS_PER_KEY (10)
+// Bits set for each element (all in the same block)
+#define CH_BLOOM_NUM_BITS (4)
+// A block is a cache line (64 bytes)
+#define CH_BLOOM_BLOCK_WORDS (8)
+
+// A blocked Bloom filter over the 32 bits hashes of the keys.
+// All the bits of a hash fall into the same block, so a query
+// touches only one cache line.
+typedef struct ch_bloom_s {
+    size_t num_blocks;
+    uint64_t *blocks;
+} ch_bloom;
+
+// Creates an empty filter sized for `capacity` elements
+ch_bloom *ch_bloom_new(size_t capacity);
+
+// Free the memory associated with the filter
+void ch_bloom_free(ch_bloom *bloom);
+
+// Adds a hash to the filter
+void ch_bloom_add(ch_bloom *bloom, uint32_t h);
+
+// Returns false if the hash was never added,
+// true if it might have been added
+bool ch_bloom_maybe(ch_bloom *bloom, uint32_t h);
+
+#endif
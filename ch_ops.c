@@ -0,0 +1,60 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "ch_ops.h"
+
+// String operations
+
+static uint32_t ch_fmix32(uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x3243f6a9U;
+    h ^= h >> 16;
+    return h;
+}
+
+uint32_t ch_string_hash(const void *data, void *arg) {
+    
+    //djb2
+    uint32_t hash = (const uint32_t) 5381;
+    const char *str = (const char*) data;
+    char c;
+    while((c=*str++)) {
+        hash = ((hash << 5) + hash) + c;
+    }
+
+    return ch_fmix32(hash);
+}
+
+
+void* ch_string_cp(const void *data, void *arg) {
+    const char *input = (const char*) data;
+    size_t input_length = strlen(input) + 1;
+    char *result;
+    result = malloc(sizeof(*result) * input_length);
+    if (NULL==result) {
+        fprintf(stderr,"malloc() failed in file %s at line # %d", __FILE__,__LINE__);
+        exit(EXIT_FAILURE);
+    }
+    strcpy(result, input);
+    return result;
+}
+
+bool ch_string_eq(const void *data1, const void *data2, void *arg) {
+    const char *str1 = (const char*) data1;
+    const char *str2 = (const char*) data2;
+    return !(strcmp(str1, str2)) ? true : false;    
+}
+
+void ch_string_free(void *data, void *arg) {
+    free(data);
+}
+
+void ch_string_print(const void *data) {
+    printf("%s", (const char*) data);
+}
+
+ch_key_ops ch_key_ops_string = { ch_string_hash, ch_string_cp, ch_string_free, ch_string_eq, NULL};
+ch_val_ops ch_val_ops_string = { ch_string_cp, ch_string_free, ch_string_eq, NULL};
\ No newline at end of file
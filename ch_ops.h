@@ -0,0 +1,40 @@
+#ifndef CH_OPS_H
+#define CH_OPS_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+typedef struct ch_key_ops_s {
+    uint32_t (*hash)(const void *data, void *arg);
+    void* (*cp)(const void *data, void *arg);
+    void (*free)(void *data, void *arg);
+    bool (*eq)(const void *data1, const void *data2, void *arg);
+    void *arg;
+} ch_key_ops;
+
+typedef struct ch_val_ops_s {
+    void* (*cp)(const void *data, void *arg);
+    void (*free)(void *data, void *arg);
+    bool (*eq)(const void *data1, const void *data2, void *arg);
+    void *arg;
+} ch_val_ops;
+
+// How lookups reorder the elements of a bucket
+typedef enum ch_reorder_e {
+    CH_REORDER_NONE,            // elements are never moved
+    CH_REORDER_MOVE_TO_FRONT,   // a found element becomes the first of its bucket
+    CH_REORDER_TRANSPOSE        // a found element is swapped with its predecessor
+} ch_reorder;
+
+// String operations
+
+uint32_t ch_string_hash(const void *data, void *arg);
+void* ch_string_cp(const void *data, void *arg);
+bool ch_string_eq(const void *data1, const void *data2, void *arg);
+void ch_string_free(void *data, void *arg);
+void ch_string_print(const void *data);
+
+extern ch_key_ops ch_key_ops_string;
+extern ch_val_ops ch_val_ops_string;
+
+#endif
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "ch_table.h"
+
+ch_table *ch_table_new(ch_engine engine, ch_key_ops k_ops, ch_val_ops v_ops) {
+    ch_table *table;
+    table = malloc(sizeof(*table));
+
+    if (NULL == table) {
+        fprintf(stderr,"malloc() failed in file %s at line # %d", __FILE__,__LINE__);
+        exit(EXIT_FAILURE);
+    }
+
+    table->engine = engine;
+    switch(engine) {
+        case CH_ENGINE_LIST:
+            table->list = ch_hash_new(k_ops, v_ops);
+            break;
+        case CH_ENGINE_VECT:
+            table->vect = ch_hashv_new(k_ops, v_ops);
+            break;
+        default:
+            fprintf(stderr, "unknown bucket engine %d.\n", engine);
+            exit(EXIT_FAILURE);
+    }
+
+    return table;
+}
+
+void ch_table_free(ch_table *table) {
+    switch(table->engine) {
+        case CH_ENGINE_LIST:
+            ch_hash_free(table->list);
+            break;
+        case CH_ENGINE_VECT:
+            ch_hashv_free(table->vect);
+            break;
+    }
+    free(table);
+}
+
+void* ch_table_get(ch_table *table, const void *k) {
+    switch(table->engine) {
+        case CH_ENGINE_LIST:
+            return ch_hash_get(table->list, k);
+        case CH_ENGINE_VECT:
+            return ch_hashv_get(table->vect, k);
+    }
+    return NULL;
+}
+
+bool ch_table_contains(ch_table *table, const void *k) {
+    switch(table->engine) {
+        case CH_ENGINE_LIST:
+            return ch_hash_contains(table->list, k);
+        case CH_ENGINE_VECT:
+            return ch_hashv_contains(table->vect, k);
+    }
+    return false;
+}
+
+void ch_table_put(ch_table *table, const void *k, const void *v) {
+    switch(table->engine) {
+        case CH_ENGINE_LIST:
+            ch_hash_put(table->list, k, v);
+            break;
+        case CH_ENGINE_VECT:
+            ch_hashv_put(table->vect, k, v);
+            break;
+    }
+}
+
+size_t ch_table_size(ch_table *table) {
+    switch(table->engine) {
+        case CH_ENGINE_LIST:
+            return table->list->size;
+        case CH_ENGINE_VECT:
+            return table->vect->size;
+    }
+    return 0;
+}
+
+void ch_table_set_reorder(ch_table *table, ch_reorder mode, uint32_t rate) {
+    switch(table->engine) {
+        case CH_ENGINE_LIST:
+            ch_hash_set_reorder(table->list, mode, rate);
+            break;
+        case CH_ENGINE_VECT:
+            ch_hashv_set_reorder(table->vect, mode, rate);
+            break;
+    }
+}
+
+uint32_t ch_table_depth(ch_table *table, const void *k) {
+    switch(table->engine) {
+        case CH_ENGINE_LIST:
+            return ch_hash_depth(table->list, k);
+        case CH_ENGINE_VECT:
+            return ch_hashv_depth(table->vect, k);
+    }
+    return 0;
+}
+
+void ch_table_print(ch_table *table, void (*print_key)(const void *k), void (*print_val)(const void *v)) {
+    switch(table->engine) {
+        case CH_ENGINE_LIST:
+            ch_hash_print(table->list, print_key, print_val);
+            break;
+        case CH_ENGINE_VECT:
+            ch_hashv_print(table->vect, print_key, print_val);
+            break;
+    }
+}
+
+uint32_t ch_table_numcol(ch_table *table) {
+    switch(table->engine) {
+        case CH_ENGINE_LIST:
+            return ch_hash_numcol(table->list);
+        case CH_ENGINE_VECT:
+            return ch_hashv_numcol(table->vect);
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+#ifndef CH_TABLE_H
+#define CH_TABLE_H
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "ch_ops.h"
+#include "chained_hash.h"
+#include "chained_hashv.h"
+
+// The bucket engine used by a table
+typedef enum ch_engine_e {
+    CH_ENGINE_LIST,     // buckets are linked lists (ch_hash)
+    CH_ENGINE_VECT      // buckets are vectors (ch_hashv)
+} ch_engine;
+
+// A hash table whose bucket engine is chosen at creation.
+// Each call is dispatched once to the engine; the engine itself
+// can also be used directly through `list` or `vect`.
+typedef struct ch_table_s {
+    ch_engine engine;
+    union {
+        ch_hash *list;
+        ch_hashv *vect;
+    };
+} ch_table;
+
+
+// Creates a new hash table using the given bucket engine
+ch_table *ch_table_new(ch_engine engine, ch_key_ops k_ops, ch_val_ops v_ops);
+
+// Free the memory associated with the table (and all of its contents)
+void ch_table_free(ch_table *table);
+
+// Gets the value coresponding to a key
+// If the key is not found returns NULL
+void* ch_table_get(ch_table *table, const void *k);
+
+// Checks if a key exists or not in the table
+bool ch_table_contains(ch_table *table, const void *k);
+
+// Adds a <key, value> pair to the table
+void ch_table_put(ch_table *table, const void *k, const void *v);
+
+// Returns the number of elements in the table
+size_t ch_table_size(ch_table *table);
+
+// Makes lookups reorder the buckets (see ch_hash_set_reorder, including the
+// note on the sampling counter shared by all the tables of a thread)
+// Once enabled, get and contains modify the table: they must not be called
+// concurrently with each other
+void ch_table_set_reorder(ch_table *table, ch_reorder mode, uint32_t rate);
+
+// Returns the number of elements probed to find a key, 0 if missing
+uint32_t ch_table_depth(ch_table *table, const void *k);
+
+// Prints the contents of the table
+void ch_table_print(ch_table *table, void (*print_key)(const void *k), void (*print_val)(const void *v));
+
+// Get the total number of collisions
+uint32_t ch_table_numcol(ch_table *table);
+
+#endif
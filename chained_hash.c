@@ -3,10 +3,11 @@
 #include <stdbool.h>
 #include <string.h>
 #include <inttypes.h>
+#include <stdatomic.h>
 
 #include "chained_hash.h"
 
-ch_hash *ch_hash_new(ch_key_ops k_ops, ch_val_ops v_ops) {
+static ch_hash *ch_hash_new_capacity(ch_key_ops k_ops, ch_val_ops v_ops, size_t capacity) {
     ch_hash *hash;
     hash = malloc(sizeof(*hash));
 
@@ -16,9 +17,14 @@ ch_hash *ch_hash_new(ch_key_ops k_ops, ch_val_ops v_ops) {
     }
 
     hash->size = 0;
-    hash->capacity = CH_HASH_CAPACITY_INIT;
+    hash->capacity = capacity;
     hash->key_ops = k_ops;
     hash->val_ops = v_ops;
+    hash->base = NULL;
+    hash->latest = NULL;
+    hash->filter = NULL;
+    hash->reorder = CH_REORDER_NONE;
+    hash->reorder_rate = 1;
 
     hash->buckets = malloc(hash->capacity * sizeof(*(hash->buckets)));
     if (NULL == hash->buckets) {
@@ -28,58 +34,202 @@ ch_hash *ch_hash_new(ch_key_ops k_ops, ch_val_ops v_ops) {
     for(int i = 0; i < hash->capacity; i++) {
         // Initially all the buckets are NULL
         // Memory will be allocated for them when needed
-        hash->buckets[i] = NULL;
+        atomic_init(&hash->buckets[i], NULL);
     }
 
     return hash;
 }
 
-void ch_hash_free(ch_hash *hash) {
-    
-    ch_node *crt;
+ch_hash *ch_hash_new(ch_key_ops k_ops, ch_val_ops v_ops) {
+    return ch_hash_new_capacity(k_ops, v_ops, CH_HASH_CAPACITY_INIT);
+}
+
+// Marks a saved chain for a bucket that was empty
+static ch_node ch_node_empty;
+
+static void ch_node_free_chain(ch_node *node, ch_key_ops *k_ops, ch_val_ops *v_ops) {
     ch_node *next;
+    while(NULL!=node) {
+        next = node->next;
 
-    for(int i = 0; i < hash->capacity; ++i) {
-        // Free memory for each bucket
-        crt = hash->buckets[i];
-        while(NULL!=crt) {
-            next = crt->next;
-            
-            // Free memory for key and value
-            hash->key_ops.free(crt->key, hash->key_ops.arg);
-            hash->val_ops.free(crt->val, hash->val_ops.arg);
+        // Free memory for key and value
+        k_ops->free(node->key, k_ops->arg);
+        v_ops->free(node->val, v_ops->arg);
 
-            // Free the node
-            free(crt);
-            crt = next;
+        // Free the node
+        free(node);
+        node = next;
+    }
+}
+
+// Drops a reference to the buckets, freeing them (and the chains they
+// still hold) if it was the last one
+static void ch_buckets_release(ch_buckets *base, ch_key_ops *k_ops, ch_val_ops *v_ops) {
+    if (1!=atomic_fetch_sub(&base->refs, 1)) {
+        // Still used by someone else
+        return;
+    }
+    for(int i = 0; i < base->capacity; ++i) {
+        ch_node_free_chain(base->buckets[i], k_ops, v_ops);
+    }
+    free(base->buckets);
+    free(base);
+}
+
+void ch_snapshot_release(ch_snapshot *snap) {
+    ch_snapshot *next;
+    ch_node *saved;
+    // A snapshot holds a reference to the next one (whose saved chains it
+    // may need), so releasing it can release the next ones as well
+    while(NULL!=snap && 1==atomic_fetch_sub(&snap->refs, 1)) {
+        for(size_t i = 0; i < snap->num_modified; ++i) {
+            saved = snap->saved[snap->modified[i]];
+            if (&ch_node_empty!=saved) {
+                ch_node_free_chain(saved, &snap->key_ops, &snap->val_ops);
+            }
+        }
+        free(snap->saved);
+        free(snap->modified);
+        ch_buckets_release(snap->base, &snap->key_ops, &snap->val_ops);
+        next = atomic_load(&snap->next);
+        free(snap);
+        snap = next;
+    }
+}
+
+// Stops sharing the buckets once the latest snapshot is not used by anyone
+// else (the older ones hold a reference to it, so they are gone too)
+static void ch_hash_drop_snapshot(ch_hash *hash) {
+    ch_snapshot_release(hash->latest);
+    hash->latest = NULL;
+    // The table holds the last reference to the buckets, it keeps them
+    free(hash->base);
+    hash->base = NULL;
+}
+
+void ch_hash_free(ch_hash *hash) {
+
+    ch_node *crt;
+
+    if (NULL!=hash->latest) {
+        // The chains modified since the latest snapshot belong to the table,
+        // the other ones to the snapshots
+        for(size_t i = 0; i < hash->latest->num_modified; ++i) {
+            crt = hash->buckets[hash->latest->modified[i]];
+            atomic_store_explicit(&hash->buckets[hash->latest->modified[i]], NULL, memory_order_relaxed);
+            ch_node_free_chain(crt, &hash->key_ops, &hash->val_ops);
         }
+        ch_snapshot_release(hash->latest);
+        ch_buckets_release(hash->base, &hash->key_ops, &hash->val_ops);
     }
-    // Free the buckets and the hash structure itself
-    free(hash->buckets);
+    else {
+        for(int i = 0; i < hash->capacity; ++i) {
+            // Free memory for each bucket
+            ch_node_free_chain(hash->buckets[i], &hash->key_ops, &hash->val_ops);
+        }
+        // Free the buckets
+        free(hash->buckets);
+    }
+    if (NULL!=hash->filter) {
+        ch_bloom_free(hash->filter);
+    }
+    // Free the hash structure itself
     free(hash);
 }
 
+// Searches a chain for a key with the given hash
+// If `prev` is not NULL, it receives the predecessor of the node found
+// (NULL if the node is the first of the chain)
+static ch_node* ch_node_find(ch_node *crt, ch_key_ops *k_ops, const void *key, uint32_t h, ch_node **prev) {
+    ch_node *before = NULL;
+    while(NULL!=crt) {
+        // Iterated through the linked list to determine if the element is present
+        if (crt->hash == h && k_ops->eq(crt->key, key, k_ops->arg)) {
+            if (NULL!=prev) {
+                *prev = before;
+            }
+            return crt;
+        }
+        before = crt;
+        crt = crt->next;
+    }
+    return NULL;
+}
+
+// Looks up a key whose hash is already known
+// (e.g. stored in a node from another table with the same key_ops)
+static ch_node* ch_hash_get_node_h(ch_hash *hash, const void *key, uint32_t h, ch_node **prev) {
+    if (NULL!=hash->filter && !ch_bloom_maybe(hash->filter, h)) {
+        // Surely not in the table, no need to touch the bucket
+        return NULL;
+    }
+    return ch_node_find(hash->buckets[h % hash->capacity], &hash->key_ops, key, h, prev);
+}
+
+// Counts the hits that could be reordered
+// It is per thread (and shared by all the tables), so sampling doesn't
+// write to the table
+static _Thread_local uint32_t ch_hash_reorder_tick = 0;
+
+// Returns true for one call out of `rate`
+static bool ch_hash_reorder_sampled(uint32_t rate) {
+    if (rate <= 1) {
+        return true;
+    }
+    if (++ch_hash_reorder_tick < rate) {
+        return false;
+    }
+    ch_hash_reorder_tick = 0;
+    return true;
+}
+
+// Looks up a key, reordering its chain if the table is self-organizing
 static ch_node* ch_hash_get_node(ch_hash *hash, const void *key) {
 
-    ch_node *result = NULL;
-    ch_node *crt = NULL;
-    uint32_t h;
+    ch_node *crt;
+    ch_node *prev = NULL;
     size_t bucket_idx;
-    
+    uint32_t h;
+    uint32_t tmp_hash;
+    void *tmp;
+
     h = hash->key_ops.hash(key, hash->key_ops.arg);
+    if (CH_REORDER_NONE==hash->reorder) {
+        return ch_hash_get_node_h(hash, key, h, NULL);
+    }
+
+    crt = ch_hash_get_node_h(hash, key, h, &prev);
+    if (NULL==crt || NULL==prev || !ch_hash_reorder_sampled(hash->reorder_rate)) {
+        // Not found, already first, or not sampled
+        return crt;
+    }
+
     bucket_idx = h % hash->capacity;
-    crt = hash->buckets[bucket_idx];
+    if (NULL!=hash->latest && NULL==atomic_load_explicit(&hash->latest->saved[bucket_idx], memory_order_relaxed)) {
+        // The chain is used by a snapshot, it's not worth copying it for a read
+        return crt;
+    }
 
-    while(NULL!=crt) {
-        // Iterated through the linked list to determine if the element is present
-        if (crt->hash == h && hash->key_ops.eq(crt->key, key, hash->val_ops.arg)) {
-            result = crt;
-            break;
-        }
-        crt = crt->next;
+    if (CH_REORDER_MOVE_TO_FRONT==hash->reorder) {
+        // Relink the node in front of the chain
+        prev->next = crt->next;
+        crt->next = hash->buckets[bucket_idx];
+        atomic_store_explicit(&hash->buckets[bucket_idx], crt, memory_order_release);
+        return crt;
     }
 
-    return result;
+    // Transpose: swap the contents of the node with its predecessor
+    tmp_hash = prev->hash;
+    prev->hash = crt->hash;
+    crt->hash = tmp_hash;
+    tmp = prev->key;
+    prev->key = crt->key;
+    crt->key = tmp;
+    tmp = prev->val;
+    prev->val = crt->val;
+    crt->val = tmp;
+
+    return prev;
 }
 
 void* ch_hash_get(ch_hash *hash, const void *k) {
@@ -90,10 +240,80 @@ void* ch_hash_get(ch_hash *hash, const void *k) {
     return NULL;
 }
 
+// Creates a node that is not linked into any chain
+static ch_node* ch_node_new(ch_hash *hash, uint32_t h, const void *k, const void *v) {
+    ch_node *crt;
+    crt = malloc(sizeof(*crt));
+    if (NULL == crt) {
+        fprintf(stderr,"malloc() failed in file %s at line # %d", __FILE__,__LINE__);
+        exit(EXIT_FAILURE);
+    }
+    crt->hash = h;
+    crt->key = hash->key_ops.cp(k, hash->key_ops.arg);
+    // NULL values are kept as they are (see ch_hash_put)
+    crt->val = v ? hash->val_ops.cp(v, hash->val_ops.arg) : 0;
+    crt->next = NULL;
+    return crt;
+}
+
+// Remembers that a snapshot saved the chain of a bucket
+static void ch_snapshot_add_modified(ch_snapshot *snap, size_t bucket_idx) {
+    if (snap->num_modified == snap->modified_capacity) {
+        snap->modified_capacity = snap->modified_capacity ? snap->modified_capacity * 2 : 16;
+        snap->modified = realloc(snap->modified, snap->modified_capacity * sizeof(*(snap->modified)));
+        if (NULL == snap->modified) {
+            fprintf(stderr,"realloc() failed in file %s at line # %d", __FILE__,__LINE__);
+            exit(EXIT_FAILURE);
+        }
+    }
+    snap->modified[snap->num_modified++] = bucket_idx;
+}
+
+// Copy on write: before the table modifies a bucket for the first time
+// after a snapshot, the chain of the bucket is handed over to the snapshot
+// and the table continues with a copy
+static void ch_hash_own_bucket(ch_hash *hash, size_t bucket_idx) {
+
+    ch_snapshot *latest = hash->latest;
+    ch_node *head;
+    ch_node *crt;
+    ch_node *copy = NULL;
+    ch_node **last = &copy;
+
+    if (NULL==latest) {
+        return;
+    }
+    if (1==atomic_load(&latest->refs)) {
+        // Nobody uses the snapshots anymore
+        ch_hash_drop_snapshot(hash);
+        return;
+    }
+    if (NULL!=atomic_load_explicit(&latest->saved[bucket_idx], memory_order_relaxed)) {
+        // Already copied
+        return;
+    }
+
+    // Copy the chain (in the same order)
+    head = hash->buckets[bucket_idx];
+    for(crt = head; NULL!=crt; crt = crt->next) {
+        *last = ch_node_new(hash, crt->hash, crt->key, crt->val);
+        last = &(*last)->next;
+    }
+
+    // The snapshots read the bucket before the saved chain,
+    // so the chain is saved before the bucket changes
+    ch_snapshot_add_modified(latest, bucket_idx);
+    atomic_store_explicit(&latest->saved[bucket_idx], head ? head : &ch_node_empty, memory_order_release);
+    atomic_store_explicit(&hash->buckets[bucket_idx], copy, memory_order_release);
+}
+
 static void ch_hash_grow(ch_hash *hash) {
     
-    ch_node **new_buckets;
+    ch_bucket *new_buckets;
     ch_node *crt;
+    ch_node *next;
+    ch_snapshot *latest;
+    ch_bloom *new_filter = NULL;
     size_t new_capacity;
     size_t new_idx;
 
@@ -104,37 +324,112 @@ static void ch_hash_grow(ch_hash *hash) {
         return;
     }
     for(int i = 0; i < new_capacity; ++i) {
-        new_buckets[i] = NULL;   
+        atomic_init(&new_buckets[i], NULL);
+    }
+    if (NULL!=hash->filter) {
+        // The filter is rebuilt for the new capacity
+        new_filter = ch_bloom_new(new_capacity);
     }
     
+    if (NULL!=hash->latest && 1==atomic_load(&hash->latest->refs)) {
+        // Nobody uses the snapshots anymore
+        ch_hash_drop_snapshot(hash);
+    }
+    latest = hash->latest;
+
     // Rehash 
     // For each bucket
     for(int i = 0; i < hash->capacity; i++) {
         // For each linked list
         crt = hash->buckets[i];
+        if (NULL!=latest && NULL==atomic_load_explicit(&latest->saved[i], memory_order_relaxed)) {
+            // The chain is still used by the snapshots: it stays
+            // in the old buckets and the table continues with a copy
+            for(; NULL!=crt; crt = crt->next) {
+                ch_node *cur = ch_node_new(hash, crt->hash, crt->key, crt->val);
+                if (NULL!=new_filter) {
+                    ch_bloom_add(new_filter, cur->hash);
+                }
+                new_idx = cur->hash % new_capacity;
+                cur->next = new_buckets[new_idx];
+                atomic_init(&new_buckets[new_idx], cur);
+            }
+            continue;
+        }
+        if (NULL!=latest) {
+            // The snapshots read the saved chain instead
+            atomic_store_explicit(&hash->buckets[i], NULL, memory_order_relaxed);
+        }
         while(NULL!=crt) {
             // Finding the new bucket
             new_idx = crt->hash % new_capacity;
-            ch_node *cur = crt;
-            crt = crt->next;
-            cur->next = new_buckets[new_idx];
-            new_buckets[new_idx] = cur;
+            if (NULL!=new_filter) {
+                ch_bloom_add(new_filter, crt->hash);
+            }
+            next = crt->next;
+            crt->next = new_buckets[new_idx];
+            atomic_init(&new_buckets[new_idx], crt);
+            crt = next;
         }
     }
 
     hash->capacity = new_capacity;
 
     // Free the old buckets
-    free(hash->buckets);
+    if (NULL!=latest) {
+        // The snapshots keep them
+        ch_snapshot_release(latest);
+        hash->latest = NULL;
+        ch_buckets_release(hash->base, &hash->key_ops, &hash->val_ops);
+        hash->base = NULL;
+    }
+    else {
+        free(hash->buckets);
+    }
     
     // Update with the new buckets
     hash->buckets = new_buckets;
+
+    if (NULL!=new_filter) {
+        ch_bloom_free(hash->filter);
+        hash->filter = new_filter;
+    }
 }
 
-void ch_hash_put(ch_hash *hash, const void *k, const void *v) {
+// Adds a new node to the table
+// The caller must make sure the key is not already present
+static void ch_hash_put_new(ch_hash *hash, uint32_t h, const void *k, const void *v) {
     ch_node *crt;
     size_t bucket_idx;
-    crt = ch_hash_get_node(hash, k);
+
+    crt = ch_node_new(hash, h, k, v);
+
+    bucket_idx = crt->hash % hash->capacity;
+    crt->next = hash->buckets[bucket_idx];
+    atomic_store_explicit(&hash->buckets[bucket_idx], crt, memory_order_release);
+
+    if (NULL!=hash->filter) {
+        ch_bloom_add(hash->filter, h);
+    }
+
+    // Element has been added succesfuly
+    hash->size++;
+
+    // Grow if needed
+    if (hash->size > hash->capacity * CH_HASH_GROWTH) {
+        ch_hash_grow(hash);
+    }
+}
+
+void ch_hash_put(ch_hash *hash, const void *k, const void *v) {
+    ch_node *crt;
+    uint32_t h;
+    h = hash->key_ops.hash(k, hash->key_ops.arg);
+
+    // Copy on write, if there are snapshots using this bucket
+    ch_hash_own_bucket(hash, h % hash->capacity);
+
+    crt = ch_hash_get_node_h(hash, k, h, NULL);
     if (crt) {
         // Key already exists
         // We need to update the value
@@ -145,31 +440,155 @@ void ch_hash_put(ch_hash *hash, const void *k, const void *v) {
         // Key doesn't exist
         // - We create a node
         // - We add a node to the correspoding bucket
-        crt = malloc(sizeof(*crt));
-        if (NULL == crt) {
+        ch_hash_put_new(hash, h, k, v);
+    }
+}
+
+bool ch_hash_contains(ch_hash *hash, const void *k) {
+    return ch_hash_get_node(hash, k) ? true : false;
+}
+
+void ch_hash_set_reorder(ch_hash *hash, ch_reorder mode, uint32_t rate) {
+    hash->reorder = mode;
+    hash->reorder_rate = rate ? rate : 1;
+}
+
+uint32_t ch_hash_depth(ch_hash *hash, const void *k) {
+    ch_node *crt;
+    uint32_t h;
+    uint32_t depth = 0;
+    h = hash->key_ops.hash(k, hash->key_ops.arg);
+    for(crt = hash->buckets[h % hash->capacity]; NULL!=crt; crt = crt->next) {
+        depth++;
+        if (crt->hash == h && hash->key_ops.eq(crt->key, k, hash->key_ops.arg)) {
+            return depth;
+        }
+    }
+    return 0;
+}
+
+void ch_hash_set_filter(ch_hash *hash, bool enabled) {
+
+    ch_node *crt;
+
+    if (NULL!=hash->filter) {
+        ch_bloom_free(hash->filter);
+        hash->filter = NULL;
+    }
+    if (!enabled) {
+        return;
+    }
+
+    // Build the filter from the current contents
+    hash->filter = ch_bloom_new(hash->capacity);
+    for(int i = 0; i < hash->capacity; i++) {
+        for(crt = hash->buckets[i]; NULL!=crt; crt = crt->next) {
+            ch_bloom_add(hash->filter, crt->hash);
+        }
+    }
+}
+
+// Snapshots
+
+ch_snapshot *ch_hash_snapshot(ch_hash *hash) {
+
+    ch_snapshot *snap;
+
+    if (NULL!=hash->latest && 1==atomic_load(&hash->latest->refs)) {
+        // Nobody uses the snapshots anymore
+        ch_hash_drop_snapshot(hash);
+    }
+
+    if (NULL!=hash->latest && 0==hash->latest->num_modified) {
+        // Nothing changed since the latest snapshot, it is reused
+        atomic_fetch_add(&hash->latest->refs, 1);
+        return hash->latest;
+    }
+
+    if (NULL==hash->base) {
+        // The buckets become shared
+        hash->base = malloc(sizeof(*(hash->base)));
+        if (NULL == hash->base) {
             fprintf(stderr,"malloc() failed in file %s at line # %d", __FILE__,__LINE__);
             exit(EXIT_FAILURE);
-        }   
-        crt->hash = hash->key_ops.hash(k, hash->key_ops.arg);
-        crt->key = hash->key_ops.cp(k, hash->key_ops.arg);
-        crt->val = hash->val_ops.cp(v, hash->val_ops.arg);
+        }
+        // One reference is held by the table
+        atomic_init(&hash->base->refs, 1);
+        hash->base->capacity = hash->capacity;
+        hash->base->buckets = hash->buckets;
+    }
 
-        bucket_idx = crt->hash % hash->capacity;
-        crt->next = hash->buckets[bucket_idx];
-        hash->buckets[bucket_idx] = crt;
-        
-        // Element has been added succesfuly
-        hash->size++;
-
-        // Grow if needed
-        if (hash->size > hash->capacity * CH_HASH_GROWTH) {
-            ch_hash_grow(hash);
+    snap = malloc(sizeof(*snap));
+    if (NULL == snap) {
+        fprintf(stderr,"malloc() failed in file %s at line # %d", __FILE__,__LINE__);
+        exit(EXIT_FAILURE);
+    }
+    snap->saved = calloc(hash->capacity, sizeof(*(snap->saved)));
+    if (NULL == snap->saved) {
+        fprintf(stderr,"calloc() failed in file %s at line # %d", __FILE__,__LINE__);
+        exit(EXIT_FAILURE);
+    }
+    // One reference is held by the table (as its latest snapshot),
+    // one is returned
+    atomic_init(&snap->refs, 2);
+    snap->size = hash->size;
+    snap->base = hash->base;
+    atomic_fetch_add(&snap->base->refs, 1);
+    snap->modified = NULL;
+    snap->num_modified = 0;
+    snap->modified_capacity = 0;
+    atomic_init(&snap->next, NULL);
+    snap->key_ops = hash->key_ops;
+    snap->val_ops = hash->val_ops;
+
+    if (NULL!=hash->latest) {
+        // The previous snapshot holds a reference to the new one,
+        // instead of the table
+        atomic_fetch_add(&snap->refs, 1);
+        atomic_store_explicit(&hash->latest->next, snap, memory_order_release);
+        ch_snapshot_release(hash->latest);
+    }
+    hash->latest = snap;
+
+    return snap;
+}
+
+// Returns the chain of a bucket, as it was when the snapshot was taken
+static ch_node* ch_snapshot_bucket(ch_snapshot *snap, size_t bucket_idx) {
+
+    ch_node *head;
+    ch_node *saved;
+    ch_snapshot *crt;
+
+    // The bucket is read before the saved chains, because the table saves
+    // a chain before changing the bucket
+    head = atomic_load_explicit(&snap->base->buckets[bucket_idx], memory_order_acquire);
+
+    // The first snapshot (starting with this one) that saved the chain
+    // has it as it was when this snapshot was taken
+    for(crt = snap; NULL!=crt && crt->base==snap->base; crt = atomic_load_explicit(&crt->next, memory_order_acquire)) {
+        saved = atomic_load_explicit(&crt->saved[bucket_idx], memory_order_acquire);
+        if (NULL!=saved) {
+            return (&ch_node_empty==saved) ? NULL : saved;
         }
     }
+
+    // Not modified since the snapshot
+    return head;
 }
 
-bool ch_hash_contains(ch_hash *hash, const void *k) {
-    return ch_hash_get_node(hash, k) ? true : false;
+void* ch_snapshot_get(ch_snapshot *snap, const void *k) {
+    ch_node *result;
+    uint32_t h;
+    h = snap->key_ops.hash(k, snap->key_ops.arg);
+    result = ch_node_find(ch_snapshot_bucket(snap, h % snap->base->capacity), &snap->key_ops, k, h, NULL);
+    return result ? result->val : NULL;
+}
+
+bool ch_snapshot_contains(ch_snapshot *snap, const void *k) {
+    uint32_t h;
+    h = snap->key_ops.hash(k, snap->key_ops.arg);
+    return ch_node_find(ch_snapshot_bucket(snap, h % snap->base->capacity), &snap->key_ops, k, h, NULL) ? true : false;
 }
 
 static uint32_t ch_node_numcol(ch_node* node) {
@@ -191,77 +610,134 @@ uint32_t ch_hash_numcol(ch_hash *hash) {
     return result;
 }
 
-void ch_hash_print(ch_hash *hash, void (*print_key)(const void *k), void (*print_val)(const void *v)) {
+// Set operations
+
+// Returns the smallest capacity that can hold `size` elements without growing
+static size_t ch_hash_capacity_for(size_t size) {
+    size_t capacity = CH_HASH_CAPACITY_INIT;
+    while (size > capacity * CH_HASH_GROWTH) {
+        capacity *= CH_HASH_CAPACITY_MULT;
+    }
+    return capacity;
+}
+
+// The stored hashes can only be reused if both tables hash (and compare)
+// the keys the same way
+static void ch_hash_check_key_ops(ch_hash *h1, ch_hash *h2) {
+    if (h1->key_ops.hash != h2->key_ops.hash || h1->key_ops.eq != h2->key_ops.eq) {
+        fprintf(stderr, "Set operations need tables with the same key hash and eq functions.\n");
+        exit(EXIT_FAILURE);
+    }
+}
 
+ch_hash *ch_hash_merge(ch_hash *h1, ch_hash *h2, ch_hash_resolve resolve, void *arg) {
+
+    ch_hash *result;
     ch_node *crt;
+    ch_node *other;
+    const void *val;
 
-    printf("Hash Capacity: %lu\n", hash->capacity);
-    printf("Hash Size: %lu\n", hash->size);
+    ch_hash_check_key_ops(h1, h2);
+    result = ch_hash_new_capacity(h1->key_ops, h1->val_ops, ch_hash_capacity_for(h1->size + h2->size));
 
-    printf("Hash Buckets:\n");
-    for(int i = 0; i < hash->capacity; i++) {
-        crt = hash->buckets[i];
-        printf("\tbucket[%d]:\n", i);
+    // Everything from h1, resolving the keys that are also in h2
+    for(int i = 0; i < h1->capacity; i++) {
+        crt = h1->buckets[i];
         while(NULL!=crt) {
-            printf("\t\thash=%" PRIu32 ", key=", crt->hash);
-            print_key(crt->key);
-            printf(", value=");
-            print_val(crt->val);
-            printf("\n");
-            crt=crt->next;
+            val = crt->val;
+            other = ch_hash_get_node_h(h2, crt->key, crt->hash, NULL);
+            if (NULL!=other) {
+                val = resolve ? resolve(crt->key, crt->val, other->val, arg) : other->val;
+            }
+            ch_hash_put_new(result, crt->hash, crt->key, val);
+            crt = crt->next;
         }
     }
-}
 
-// String operations
+    // The keys that are only in h2
+    for(int i = 0; i < h2->capacity; i++) {
+        crt = h2->buckets[i];
+        while(NULL!=crt) {
+            if (NULL==ch_hash_get_node_h(h1, crt->key, crt->hash, NULL)) {
+                ch_hash_put_new(result, crt->hash, crt->key, crt->val);
+            }
+            crt = crt->next;
+        }
+    }
 
-static uint32_t ch_hash_fmix32(uint32_t h) {
-    h ^= h >> 16;
-    h *= 0x3243f6a9U;
-    h ^= h >> 16;
-    return h;
+    return result;
 }
 
-uint32_t ch_string_hash(const void *data, void *arg) {
-    
-    //djb2
-    uint32_t hash = (const uint32_t) 5381;
-    const char *str = (const char*) data;
-    char c;
-    while((c=*str++)) {
-        hash = ((hash << 5) + hash) + c;
+ch_hash *ch_hash_intersect(ch_hash *h1, ch_hash *h2) {
+
+    ch_hash *result;
+    ch_hash *small;
+    ch_hash *large;
+    ch_node *crt;
+    ch_node *other;
+
+    ch_hash_check_key_ops(h1, h2);
+
+    // Iterate over the smaller table and probe the larger one
+    small = (h1->size <= h2->size) ? h1 : h2;
+    large = (small == h1) ? h2 : h1;
+
+    result = ch_hash_new_capacity(h1->key_ops, h1->val_ops, ch_hash_capacity_for(small->size));
+
+    for(int i = 0; i < small->capacity; i++) {
+        crt = small->buckets[i];
+        while(NULL!=crt) {
+            other = ch_hash_get_node_h(large, crt->key, crt->hash, NULL);
+            if (NULL!=other) {
+                // Values are always taken from h1
+                ch_hash_put_new(result, crt->hash, crt->key, (small == h1) ? crt->val : other->val);
+            }
+            crt = crt->next;
+        }
     }
 
-    return ch_hash_fmix32(hash);
+    return result;
 }
 
+ch_hash *ch_hash_difference(ch_hash *h1, ch_hash *h2) {
 
-void* ch_string_cp(const void *data, void *arg) {
-    const char *input = (const char*) data;
-    size_t input_length = strlen(input) + 1;
-    char *result;
-    result = malloc(sizeof(*result) * input_length);
-    if (NULL==result) {
-        fprintf(stderr,"malloc() failed in file %s at line # %d", __FILE__,__LINE__);
-        exit(EXIT_FAILURE);
+    ch_hash *result;
+    ch_node *crt;
+
+    ch_hash_check_key_ops(h1, h2);
+    result = ch_hash_new_capacity(h1->key_ops, h1->val_ops, ch_hash_capacity_for(h1->size));
+
+    for(int i = 0; i < h1->capacity; i++) {
+        crt = h1->buckets[i];
+        while(NULL!=crt) {
+            if (NULL==ch_hash_get_node_h(h2, crt->key, crt->hash, NULL)) {
+                ch_hash_put_new(result, crt->hash, crt->key, crt->val);
+            }
+            crt = crt->next;
+        }
     }
-    strcpy(result, input);
+
     return result;
 }
 
-bool ch_string_eq(const void *data1, const void *data2, void *arg) {
-    const char *str1 = (const char*) data1;
-    const char *str2 = (const char*) data2;
-    return !(strcmp(str1, str2)) ? true : false;    
-}
+void ch_hash_print(ch_hash *hash, void (*print_key)(const void *k), void (*print_val)(const void *v)) {
 
-void ch_string_free(void *data, void *arg) {
-    free(data);
-}
+    ch_node *crt;
 
-void ch_string_print(const void *data) {
-    printf("%s", (const char*) data);
-}
+    printf("Hash Capacity: %lu\n", hash->capacity);
+    printf("Hash Size: %lu\n", hash->size);
 
-ch_key_ops ch_key_ops_string = { ch_string_hash, ch_string_cp, ch_string_free, ch_string_eq, NULL};
-ch_val_ops ch_val_ops_string = { ch_string_cp, ch_string_free, ch_string_eq, NULL};
\ No newline at end of file
+    printf("Hash Buckets:\n");
+    for(int i = 0; i < hash->capacity; i++) {
+        crt = hash->buckets[i];
+        printf("\tbucket[%d]:\n", i);
+        while(NULL!=crt) {
+            printf("\t\thash=%" PRIu32 ", key=", crt->hash);
+            print_key(crt->key);
+            printf(", value=");
+            print_val(crt->val);
+            printf("\n");
+            crt=crt->next;
+        }
+    }
+}
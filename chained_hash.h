@@ -1,22 +1,18 @@
+#ifndef CHAINED_HASH_H
+#define CHAINED_HASH_H
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "ch_ops.h"
+#include "ch_bloom.h"
+
 #define CH_HASH_CAPACITY_INIT (32)
 #define CH_HASH_CAPACITY_MULT (2)
 #define CH_HASH_GROWTH (1)
 
-typedef struct ch_key_ops_s {
-    uint32_t (*hash)(const void *data, void *arg);
-    void* (*cp)(const void *data, void *arg);
-    void (*free)(void *data, void *arg);
-    bool (*eq)(const void *data1, const void *data2, void *arg);
-    void *arg;
-} ch_key_ops;
-
-typedef struct ch_val_ops_s {
-    void* (*cp)(const void *data, void *arg);
-    void (*free)(void *data, void *arg);
-    bool (*eq)(const void *data1, const void *data2, void *arg);
-    void *arg;
-} ch_val_ops;
-
 typedef struct ch_node_s {
     uint32_t hash;
     void *key;
@@ -24,14 +20,57 @@ typedef struct ch_node_s {
     struct ch_node_s *next;
 } ch_node;
 
+// A bucket can be read by snapshots (from other threads)
+// while the table is modifying it
+typedef _Atomic(ch_node*) ch_bucket;
+
+// The buckets of a table, shared with its snapshots
+typedef struct ch_buckets_s {
+    _Atomic uint32_t refs;
+    size_t capacity;
+    ch_bucket *buckets;
+} ch_buckets;
+
+// A read-only view of a table at the time it was taken
+typedef struct ch_snapshot_s {
+    _Atomic uint32_t refs;
+    size_t size;
+    // The buckets of the table when the snapshot was taken
+    ch_buckets *base;
+    // For each bucket the table modified after this snapshot (and before
+    // the next one), the chain it had before; NULL for the other buckets
+    ch_bucket *saved;
+    // The indexes of the saved chains
+    size_t *modified;
+    size_t num_modified;
+    size_t modified_capacity;
+    // The next (newer) snapshot of the table
+    _Atomic(struct ch_snapshot_s*) next;
+    ch_key_ops key_ops;
+    ch_val_ops val_ops;
+} ch_snapshot;
+
 typedef struct ch_hash_s {
     size_t capacity;
     size_t size;
-    ch_node **buckets;
+    ch_bucket *buckets;
     ch_key_ops key_ops;
     ch_val_ops val_ops;
+    // The buckets shared with snapshots, NULL if there are none
+    ch_buckets *base;
+    // The most recent snapshot, NULL if there are none
+    ch_snapshot *latest;
+    // Optional filter answering most lookups of missing keys, NULL if disabled
+    ch_bloom *filter;
+    // Self-organizing buckets: one hit out of `reorder_rate` is reordered
+    ch_reorder reorder;
+    uint32_t reorder_rate;
 } ch_hash;
 
+// Decides the value of a key present in both tables during a merge
+// The returned value is copied into the resulting table (NULL is kept as NULL)
+typedef const void* (*ch_hash_resolve)(const void *key, const void *val1, const void *val2, void *arg);
+
 
 // Creates a new hash table
 ch_hash *ch_hash_new(ch_key_ops k_ops, ch_val_ops v_ops);
@@ -49,19 +88,74 @@ bool ch_hash_contains(ch_hash *hash, const void *k);
 // Adds a <key, value> pair to the table
 void ch_hash_put(ch_hash *hash, const void *k, const void *v);
 
+// Enables (or disables) a Bloom filter kept alongside the table
+// Lookups of missing keys are then mostly answered without reading the buckets
+// Only available on the linked list engine (not on ch_hashv or ch_table)
+void ch_hash_set_filter(ch_hash *hash, bool enabled);
+
+// Makes lookups (get, contains) reorder the chains, so frequently accessed
+// keys move towards the front of their bucket
+// Only one hit out of `rate` is reordered (0 or 1 means every hit)
+// Once enabled, get and contains modify the table: they must not be called
+// concurrently with each other (reads of snapshots are not affected)
+// The sampling counter is per thread and shared by all the tables, so
+// lookups on tables with different rates disturb each other's sampling
+void ch_hash_set_reorder(ch_hash *hash, ch_reorder mode, uint32_t rate);
+
+// Returns the number of nodes probed to find a key (1 if it is the first
+// of its chain), or 0 if the key is not in the table
+uint32_t ch_hash_depth(ch_hash *hash, const void *k);
+
 // Prints the contents of the hash table 
 void ch_hash_print(ch_hash *hash, void (*print_key)(const void *k), void (*print_val)(const void *v));
 
 // Get the total number of collisions
 uint32_t ch_hash_numcol(ch_hash *hash);
 
-// String operations
+// Set operations
+// Both tables must use the same key_ops hash and eq functions (otherwise
+// the program exits), so the hashes stored in the nodes can be reused
+// instead of being computed again.
+// The result is a new table (using the operations of h1) sized upfront,
+// so it never grows while being filled.
+// Parallel execution is not supported: each operation fills its result
+// sequentially, as a table can't be written by several threads at once.
+
+// Returns a new table with the keys from both h1 and h2
+// For keys present in both, the value is given by resolve(key, v1, v2, arg),
+// which may return NULL. If resolve is NULL the value from h2 is kept.
+// NULL values from either table are kept as NULL.
+ch_hash *ch_hash_merge(ch_hash *h1, ch_hash *h2, ch_hash_resolve resolve, void *arg);
+
+// Returns a new table with the keys present in both h1 and h2 (values from h1)
+ch_hash *ch_hash_intersect(ch_hash *h1, ch_hash *h2);
+
+// Returns a new table with the keys from h1 that are not present in h2
+ch_hash *ch_hash_difference(ch_hash *h1, ch_hash *h2);
+
+// Snapshots
+// A snapshot is taken in O(1) (it only allocates a zeroed array of one
+// pointer per bucket): it shares the buckets and the chains with the table.
+// The first time the table modifies a bucket after a snapshot, the chain of
+// that bucket is handed over to the snapshot and the table continues with
+// a copy. Other buckets are not touched.
+// Growing the table while snapshots are alive copies all the chains the
+// snapshots still share, so memory temporarily doubles.
+// Snapshots can be read (and released) from other threads while the
+// table is being modified, but ch_hash_snapshot() must be called from the
+// thread writing to the table.
+
+// Returns a read-only view of the current contents of the table
+ch_snapshot *ch_hash_snapshot(ch_hash *hash);
+
+// Releases a snapshot, freeing the chains no longer used by anyone
+void ch_snapshot_release(ch_snapshot *snap);
+
+// Gets the value coresponding to a key in the snapshot
+// If the key is not found returns NULL
+void* ch_snapshot_get(ch_snapshot *snap, const void *k);
 
-uint32_t ch_string_hash(const void *data, void *arg);
-void* ch_string_cp(const void *data, void *arg);
-bool ch_string_eq(const void *data1, const void *data2, void *arg);
-void ch_string_free(void *data, void *arg);
-void ch_string_print(const void *data);
+// Checks if a key exists or not in the snapshot
+bool ch_snapshot_contains(ch_snapshot *snap, const void *k);
 
-extern ch_key_ops ch_key_ops_string;
-extern ch_val_ops ch_val_ops_string;
\ No newline at end of file
+#endif
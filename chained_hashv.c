@@ -17,9 +17,11 @@ ch_hashv *ch_hashv_new(ch_key_ops k_ops, ch_val_ops v_ops) {
     }
 
     hash->size = 0;
-    hash->capacity = CH_HASH_CAPACITY_INIT;
+    hash->capacity = CH_HASHV_CAPACITY_INIT;
     hash->key_ops = k_ops;
     hash->val_ops = v_ops;
+    hash->reorder = CH_REORDER_NONE;
+    hash->reorder_rate = 1;
     hash->buckets = malloc(hash->capacity * sizeof(*(hash->buckets)));
 
     if (NULL == hash->buckets) {
@@ -35,9 +37,9 @@ ch_hashv *ch_hashv_new(ch_key_ops k_ops, ch_val_ops v_ops) {
     return hash;
 }
 
-void ch_hash_free(ch_hashv *htable) {
+void ch_hashv_free(ch_hashv *htable) {
     ch_vect *crt;
-    ch_node *crt_el;
+    ch_vnode *crt_el;
     for(int i = 0; i < htable->capacity; ++i) {
         // Free memory for each bucket
         crt = htable->buckets[i];
@@ -48,18 +50,58 @@ void ch_hash_free(ch_hashv *htable) {
                 htable->val_ops.free(crt_el->val, htable->val_ops.arg);
                 free(crt_el);
             }
+            ch_vect_free(crt);
         }
-        ch_vect_free(crt);
     }
     // Free the buckets and the hash structure itself
     free(htable->buckets);
     free(htable);
 }
 
-static ch_node* ch_hashv_get_node(ch_hashv *htable, const void *key) {
+// Counts the hits that could be reordered
+// It is per thread (and shared by all the tables), so sampling doesn't
+// write to the table
+static _Thread_local uint32_t ch_hashv_reorder_tick = 0;
 
-    ch_node *result = NULL;
-    ch_node *crt_node = NULL;
+// Returns true for one call out of `rate`
+static bool ch_hashv_reorder_sampled(uint32_t rate) {
+    if (rate <= 1) {
+        return true;
+    }
+    if (++ch_hashv_reorder_tick < rate) {
+        return false;
+    }
+    ch_hashv_reorder_tick = 0;
+    return true;
+}
+
+// Moves the element found at `idx` towards the front of the bucket
+static void ch_hashv_reorder(ch_hashv *htable, ch_vect *bucket, size_t idx) {
+
+    void *found;
+
+    if (0==idx || !ch_hashv_reorder_sampled(htable->reorder_rate)) {
+        // Already first, or not sampled
+        return;
+    }
+
+    found = bucket->array[idx];
+    if (CH_REORDER_MOVE_TO_FRONT==htable->reorder) {
+        memmove(&bucket->array[1], &bucket->array[0], idx * sizeof(*(bucket->array)));
+        bucket->array[0] = found;
+    }
+    else {
+        bucket->array[idx] = bucket->array[idx-1];
+        bucket->array[idx-1] = found;
+    }
+}
+
+// Looks up a key
+// If `reorder` is true and the table is self-organizing, the bucket is reordered
+static ch_vnode* ch_hashv_get_node(ch_hashv *htable, const void *key, bool reorder) {
+
+    ch_vnode *result = NULL;
+    ch_vnode *crt_node = NULL;
     ch_vect *crt_bucket = NULL;
 
     uint32_t computed_hash;
@@ -75,6 +117,9 @@ static ch_node* ch_hashv_get_node(ch_hashv *htable, const void *key) {
             if (crt_node->hash == computed_hash) {
                 if (htable->key_ops.eq(crt_node->key, key, htable->key_ops.arg)) {
                     result = crt_node;
+                    if (reorder && CH_REORDER_NONE!=htable->reorder) {
+                        ch_hashv_reorder(htable, crt_bucket, i);
+                    }
                     break;
                 }
             }
@@ -84,7 +129,7 @@ static ch_node* ch_hashv_get_node(ch_hashv *htable, const void *key) {
 }
 
 void* ch_hashv_get(ch_hashv *htable, const void *k) {
-    ch_node *result = ch_hashv_get_node(htable, k);
+    ch_vnode *result = ch_hashv_get_node(htable, k, true);
 
     if (NULL!=result) {
         return result->val;
@@ -93,15 +138,15 @@ void* ch_hashv_get(ch_hashv *htable, const void *k) {
     return NULL;
 }
 
-static void ch_hash_grow(ch_hashv *htable) {
+static void ch_hashv_grow(ch_hashv *htable) {
     
     ch_vect **new_buckets;
     ch_vect *crt_bucket;
-    ch_node *crt_element;
+    ch_vnode *crt_element;
     size_t new_capacity;
     size_t new_idx;
 
-    new_capacity = htable->capacity * CH_HASH_CAPACITY_MULT;
+    new_capacity = htable->capacity * CH_HASHV_CAPACITY_MULT;
     new_buckets = malloc(sizeof(*new_buckets) * new_capacity);
 
     if (NULL==new_buckets) {
@@ -131,6 +176,8 @@ static void ch_hash_grow(ch_hashv *htable) {
                 // Add the element to the corresponding bucket
                 ch_vect_append(new_buckets[new_idx], crt_element);   
             }
+            // The old bucket is no longer needed
+            ch_vect_free(crt_bucket);
         }
     }
 
@@ -145,10 +192,10 @@ static void ch_hash_grow(ch_hashv *htable) {
 
 void ch_hashv_put(ch_hashv *htable, const void *k, const void *v) {
 
-    ch_node *crt;
+    ch_vnode *crt;
     size_t bucket_idx;
 
-    crt = ch_hashv_get_node(htable, k);
+    crt = ch_hashv_get_node(htable, k, false);
 
     if (NULL!=crt) {
         // Key already exists
@@ -180,18 +227,40 @@ void ch_hashv_put(ch_hashv *htable, const void *k, const void *v) {
         htable->size++;
 
         // Grow if needed
-        if (htable->size > htable->capacity * CH_HASH_GROWTH) {
-            ch_hash_grow(htable);
+        if (htable->size > htable->capacity * CH_HASHV_GROWTH) {
+            ch_hashv_grow(htable);
         }
     }
 }
 
 bool ch_hashv_contains(ch_hashv *htable, const void *k) {
-    return ch_hashv_get_node(htable, k) ? true : false;
+    return ch_hashv_get_node(htable, k, true) ? true : false;
+}
+
+void ch_hashv_set_reorder(ch_hashv *htable, ch_reorder mode, uint32_t rate) {
+    htable->reorder = mode;
+    htable->reorder_rate = rate ? rate : 1;
+}
+
+uint32_t ch_hashv_depth(ch_hashv *htable, const void *k) {
+    ch_vect *crt_bucket;
+    ch_vnode *crt_node;
+    uint32_t computed_hash;
+    computed_hash = htable->key_ops.hash(k, htable->key_ops.arg);
+    crt_bucket = htable->buckets[computed_hash % htable->capacity];
+    if (NULL!=crt_bucket) {
+        for(int i = 0; i < crt_bucket->size; ++i) {
+            crt_node = crt_bucket->array[i];
+            if (crt_node->hash == computed_hash && htable->key_ops.eq(crt_node->key, k, htable->key_ops.arg)) {
+                return i + 1;
+            }
+        }
+    }
+    return 0;
 }
 
 static uint32_t ch_node_numcol(ch_vect* bucket) {
-    return (bucket->size == 0) ? 0 : bucket->size-1;
+    return (NULL == bucket || bucket->size == 0) ? 0 : bucket->size-1;
 }
 
 uint32_t ch_hashv_numcol(ch_hashv *htable) {
@@ -205,7 +274,7 @@ uint32_t ch_hashv_numcol(ch_hashv *htable) {
 void ch_hashv_print(ch_hashv *htable, void (*print_key)(const void *k), void (*print_val)(const void *v)) {
 
     ch_vect *crt_bucket;
-    ch_node *crt_el;
+    ch_vnode *crt_el;
 
     printf("Hash Capacity: %lu\n", htable->capacity);
     printf("Hash Size: %lu\n", htable->size);
@@ -226,54 +295,3 @@ void ch_hashv_print(ch_hashv *htable, void (*print_key)(const void *k), void (*p
         }
     }
 }
-
-// String operations
-
-static uint32_t ch_hashv_fmix32(uint32_t h) {
-    h ^= h >> 16;
-    h *= 0x3243f6a9U;
-    h ^= h >> 16;
-    return h;
-}
-
-uint32_t ch_string_hash(const void *data, void *arg) {
-    //djb2
-    uint32_t hash = (const uint32_t) 5381;
-    const char *str = (const char*) data;
-    char c;
-    while((c=*str++)) {
-        hash = ((hash << 5) + hash) + c;
-    }
-    return ch_hashv_fmix32(hash);
-}
-
-
-void* ch_string_cp(const void *data, void *arg) {
-    const char *input = (const char*) data;
-    size_t input_length = strlen(input) + 1;
-    char *result;
-    result = malloc(sizeof(*result) * input_length);
-    if (NULL==result) {
-        fprintf(stderr,"malloc() failed in file %s at line # %d", __FILE__,__LINE__);
-        exit(EXIT_FAILURE);
-    }
-    strcpy(result, input);
-    return result;
-}
-
-bool ch_string_eq(const void *data1, const void *data2, void *arg) {
-    const char *str1 = (const char*) data1;
-    const char *str2 = (const char*) data2;
-    return !(strcmp(str1, str2)) ? true : false;    
-}
-
-void ch_string_free(void *data, void *arg) {
-    free(data);
-}
-
-void ch_string_print(const void *data) {
-    printf("%s", (const char*) data);
-}
-
-ch_key_ops ch_key_ops_string = { ch_string_hash, ch_string_cp, ch_string_free, ch_string_eq, NULL};
-ch_val_ops ch_val_ops_string = { ch_string_cp, ch_string_free, ch_string_eq, NULL };
\ No newline at end of file
@@ -1,33 +1,22 @@
+#ifndef CHAINED_HASHV_H
+#define CHAINED_HASHV_H
+
 #include <inttypes.h>
 #include <stddef.h>
 #include <stdbool.h>
 
+#include "ch_ops.h"
 #include "vect.h"
 
-#define CH_HASH_CAPACITY_INIT (1024)
-#define CH_HASH_CAPACITY_MULT (2)
-#define CH_HASH_GROWTH (1)
-
-typedef struct ch_key_ops_s {
-    uint32_t (*hash)(const void *data, void *arg);
-    void* (*cp)(const void *data, void *arg);
-    void (*free)(void *data, void *arg);
-    bool (*eq)(const void *data1, const void *data2, void *arg);
-    void *arg;
-} ch_key_ops;
-
-typedef struct ch_val_ops_s {
-    void* (*cp)(const void *data, void *arg);
-    void (*free)(void *data, void *arg);
-    bool (*eq)(const void *data1, const void *data2, void *arg);
-    void *arg;
-} ch_val_ops;
-
-typedef struct ch_node_s {
+#define CH_HASHV_CAPACITY_INIT (1024)
+#define CH_HASHV_CAPACITY_MULT (2)
+#define CH_HASHV_GROWTH (1)
+
+typedef struct ch_vnode_s {
     uint32_t hash;
     void *key;
     void *val;
-} ch_node;
+} ch_vnode;
 
 typedef struct ch_hashv_s {
     size_t capacity;
@@ -35,6 +24,9 @@ typedef struct ch_hashv_s {
     ch_vect **buckets;
     ch_key_ops key_ops;
     ch_val_ops val_ops;
+    // Self-organizing buckets: one hit out of `reorder_rate` is reordered
+    ch_reorder reorder;
+    uint32_t reorder_rate;
 } ch_hashv;
 
 
@@ -54,19 +46,23 @@ bool ch_hashv_contains(ch_hashv *htable, const void *k);
 // Adds a <key, value> pair to the table
 void ch_hashv_put(ch_hashv *htable, const void *k, const void *v);
 
+// Makes lookups (get, contains) reorder the buckets, so frequently accessed
+// keys move towards the front of their bucket
+// Only one hit out of `rate` is reordered (0 or 1 means every hit)
+// Once enabled, get and contains modify the table: they must not be called
+// concurrently with each other
+// The sampling counter is per thread and shared by all the tables, so
+// lookups on tables with different rates disturb each other's sampling
+void ch_hashv_set_reorder(ch_hashv *htable, ch_reorder mode, uint32_t rate);
+
+// Returns the number of elements probed to find a key (1 if it is the first
+// of its bucket), or 0 if the key is not in the table
+uint32_t ch_hashv_depth(ch_hashv *htable, const void *k);
+
 // Prints the contents of the hash table 
 void ch_hashv_print(ch_hashv *htable, void (*print_key)(const void *k), void (*print_val)(const void *v));
 
 // Get the total number of collisions
 uint32_t ch_hashv_numcol(ch_hashv *hash);
 
-// String operations
-
-uint32_t ch_string_hash(const void *data, void *arg);
-void* ch_string_cp(const void *data, void *arg);
-bool ch_string_eq(const void *data1, const void *data2, void *arg);
-void ch_string_free(void *data, void *arg);
-void ch_string_print(const void *data);
-
-extern ch_key_ops ch_key_ops_string;
-extern ch_val_ops ch_val_ops_string;
\ No newline at end of file
+#endif
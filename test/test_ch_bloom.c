@@ -0,0 +1,33 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "../ch_bloom.h"
+
+#define NUM_HASHES (100000)
+
+// Every hash added is reported, few others are
+static void test_bloom(void) {
+    ch_bloom *bloom = ch_bloom_new(NUM_HASHES);
+    uint32_t false_positives = 0;
+
+    for(uint32_t i = 0; i < NUM_HASHES; i++) {
+        ch_bloom_add(bloom, i * 0x9e3779b1U);
+    }
+    for(uint32_t i = 0; i < NUM_HASHES; i++) {
+        assert(ch_bloom_maybe(bloom, i * 0x9e3779b1U));
+    }
+    for(uint32_t i = NUM_HASHES; i < 2 * NUM_HASHES; i++) {
+        false_positives += ch_bloom_maybe(bloom, i * 0x9e3779b1U);
+    }
+    // About 1-2% at full load
+    assert(false_positives < NUM_HASHES / 20);
+
+    ch_bloom_free(bloom);
+}
+
+int main(void) {
+    test_bloom();
+    printf("All tests passed.\n");
+    return 0;
+}
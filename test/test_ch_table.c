@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../ch_table.h"
+
+// Number of non empty buckets, read from the engine
+static uint32_t non_empty_buckets(ch_table *table) {
+    uint32_t result = 0;
+    switch(table->engine) {
+        case CH_ENGINE_LIST:
+            for(size_t i = 0; i < table->list->capacity; i++) {
+                result += (NULL != table->list->buckets[i]);
+            }
+            break;
+        case CH_ENGINE_VECT:
+            for(size_t i = 0; i < table->vect->capacity; i++) {
+                result += (NULL != table->vect->buckets[i] && table->vect->buckets[i]->size > 0);
+            }
+            break;
+    }
+    return result;
+}
+
+static void test_engine(ch_engine engine) {
+    ch_table *table;
+    char key[32];
+    char val[32];
+
+    // An empty table (all the buckets are NULL) can be inspected and freed
+    table = ch_table_new(engine, ch_key_ops_string, ch_val_ops_string);
+    assert(0 == ch_table_size(table));
+    assert(0 == ch_table_numcol(table));
+    assert(!ch_table_contains(table, "k0"));
+    assert(NULL == ch_table_get(table, "k0"));
+    ch_table_free(table);
+
+    // Enough elements to grow the vector engine (1024 buckets) a few times,
+    // leaks of the old buckets are reported with -fsanitize=address
+    table = ch_table_new(engine, ch_key_ops_string, ch_val_ops_string);
+    for(int i = 0; i < 5000; i++) {
+        sprintf(key, "k%d", i);
+        ch_table_put(table, key, key);
+    }
+    assert(5000 == ch_table_size(table));
+    if (CH_ENGINE_VECT == engine) {
+        assert(table->vect->capacity > CH_HASHV_CAPACITY_INIT);
+    }
+
+    // Updates don't change the size
+    for(int i = 0; i < 5000; i += 2) {
+        sprintf(key, "k%d", i);
+        sprintf(val, "v%d", i);
+        ch_table_put(table, key, val);
+    }
+    assert(5000 == ch_table_size(table));
+
+    for(int i = 0; i < 5000; i++) {
+        sprintf(key, "k%d", i);
+        sprintf(val, (i % 2) ? "k%d" : "v%d", i);
+        assert(ch_table_contains(table, key));
+        assert(0 == strcmp(val, ch_table_get(table, key)));
+    }
+    assert(!ch_table_contains(table, "k5000"));
+    assert(NULL == ch_table_get(table, "k5000"));
+
+    // Every element beyond the first of its bucket is a collision
+    // (some buckets are still empty)
+    assert(non_empty_buckets(table) < (CH_ENGINE_LIST == engine ? table->list->capacity : table->vect->capacity));
+    assert(5000 - non_empty_buckets(table) == ch_table_numcol(table));
+
+    ch_table_free(table);
+}
+
+int main(void) {
+    test_engine(CH_ENGINE_LIST);
+    test_engine(CH_ENGINE_VECT);
+    printf("All tests passed.\n");
+    return 0;
+}
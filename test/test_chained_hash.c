@@ -0,0 +1,570 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../chained_hash.h"
+
+static ch_hash *new_string_hash(void) {
+    return ch_hash_new(ch_key_ops_string, ch_val_ops_string);
+}
+
+// Fills `keys` with `n` keys falling into the same bucket of a table
+// with the given capacity
+static void same_bucket_keys(size_t capacity, char keys[][16], int n) {
+    char key[16];
+    size_t bucket_idx = 0;
+    int found = 0;
+    for(int i = 0; found < n; i++) {
+        sprintf(key, "b%d", i);
+        if (0 == found) {
+            bucket_idx = ch_string_hash(key, NULL) % capacity;
+        }
+        if (ch_string_hash(key, NULL) % capacity == bucket_idx) {
+            strcpy(keys[found++], key);
+        }
+    }
+}
+
+// A NULL value must survive the copy of its chain on write
+static void test_snapshot_null_value(void) {
+    ch_hash *hash = new_string_hash();
+    ch_snapshot *snap;
+
+    ch_hash_put(hash, "x", "1");
+    ch_hash_put(hash, "x", NULL);
+    snap = ch_hash_snapshot(hash);
+    ch_hash_put(hash, "x", "2");
+
+    assert(ch_snapshot_contains(snap, "x"));
+    assert(NULL == ch_snapshot_get(snap, "x"));
+    assert(0 == strcmp("2", ch_hash_get(hash, "x")));
+
+    ch_snapshot_release(snap);
+    ch_hash_free(hash);
+}
+
+// A NULL value must survive the copy of the chains while growing
+static void test_snapshot_null_value_grow(void) {
+    ch_hash *hash = new_string_hash();
+    ch_snapshot *snap;
+    char key[32];
+
+    ch_hash_put(hash, "x", "1");
+    ch_hash_put(hash, "x", NULL);
+    snap = ch_hash_snapshot(hash);
+    for(int i = 0; i < CH_HASH_CAPACITY_INIT * 4; i++) {
+        sprintf(key, "k%d", i);
+        ch_hash_put(hash, key, key);
+    }
+
+    assert(ch_hash_contains(hash, "x"));
+    assert(NULL == ch_hash_get(hash, "x"));
+    assert(1 == snap->size);
+
+    ch_snapshot_release(snap);
+    ch_hash_free(hash);
+}
+
+static int resolve_calls = 0;
+
+// Checks that it receives the value from h1 first, then the one from h2
+static const void *resolve_check_order(const void *key, const void *val1, const void *val2, void *arg) {
+    resolve_calls++;
+    assert(0 == strcmp("h1", val1));
+    assert(0 == strcmp("h2", val2));
+    assert(0 == strcmp("merged", arg));
+    return arg;
+}
+
+// Fills a table with the keys [from, to) and the given value
+static ch_hash *new_range_hash(int from, int to, const char *val) {
+    ch_hash *hash = new_string_hash();
+    char key[32];
+    for(int i = from; i < to; i++) {
+        sprintf(key, "k%d", i);
+        ch_hash_put(hash, key, val);
+    }
+    return hash;
+}
+
+// Checks that the keys [from, to) have the given value in a table
+static void check_hash_range(ch_hash *hash, int from, int to, const char *val) {
+    char key[32];
+    for(int i = from; i < to; i++) {
+        sprintf(key, "k%d", i);
+        if (NULL == val) {
+            assert(!ch_hash_contains(hash, key));
+        }
+        else {
+            assert(0 == strcmp(val, ch_hash_get(hash, key)));
+        }
+    }
+}
+
+static void test_merge(void) {
+    ch_hash *h1 = new_range_hash(0, 100, "h1");
+    ch_hash *h2 = new_range_hash(50, 150, "h2");
+    ch_hash *result;
+
+    resolve_calls = 0;
+    result = ch_hash_merge(h1, h2, resolve_check_order, "merged");
+    assert(50 == resolve_calls);
+    assert(150 == result->size);
+    check_hash_range(result, 0, 50, "h1");
+    check_hash_range(result, 50, 100, "merged");
+    check_hash_range(result, 100, 150, "h2");
+    // Sized for both tables upfront (256), it never grew
+    assert(256 == result->capacity);
+    ch_hash_free(result);
+
+    ch_hash_free(h1);
+    ch_hash_free(h2);
+}
+
+static void test_intersect(void) {
+    ch_hash *h1 = new_range_hash(0, 100, "h1");
+    ch_hash *h2 = new_range_hash(90, 110, "h2");
+    ch_hash *result;
+
+    // h2 is the smaller table, the values still come from h1
+    result = ch_hash_intersect(h1, h2);
+    assert(10 == result->size);
+    check_hash_range(result, 80, 90, NULL);
+    check_hash_range(result, 90, 100, "h1");
+    check_hash_range(result, 100, 110, NULL);
+    // Sized for the smaller table upfront (32), it never grew
+    assert(32 == result->capacity);
+    ch_hash_free(result);
+
+    // h1 is the smaller table
+    result = ch_hash_intersect(h2, h1);
+    assert(10 == result->size);
+    check_hash_range(result, 90, 100, "h2");
+    ch_hash_free(result);
+
+    ch_hash_free(h1);
+    ch_hash_free(h2);
+}
+
+static void test_difference(void) {
+    ch_hash *h1 = new_range_hash(0, 100, "h1");
+    ch_hash *h2 = new_range_hash(50, 150, "h2");
+    ch_hash *result;
+
+    result = ch_hash_difference(h1, h2);
+    assert(50 == result->size);
+    check_hash_range(result, 0, 50, "h1");
+    check_hash_range(result, 50, 150, NULL);
+    // Sized for h1 upfront (128), it never grew
+    assert(128 == result->capacity);
+    ch_hash_free(result);
+
+    result = ch_hash_difference(h2, h1);
+    assert(50 == result->size);
+    check_hash_range(result, 0, 100, NULL);
+    check_hash_range(result, 100, 150, "h2");
+    ch_hash_free(result);
+
+    ch_hash_free(h1);
+    ch_hash_free(h2);
+}
+
+static const void *resolve_null(const void *key, const void *val1, const void *val2, void *arg) {
+    return NULL;
+}
+
+// Writes to a bucket after a snapshot don't change what the snapshot sees
+static void test_snapshot_isolation(void) {
+    ch_hash *hash = new_string_hash();
+    ch_snapshot *snap;
+    char keys[3][16];
+
+    same_bucket_keys(hash->capacity, keys, 3);
+    ch_hash_put(hash, keys[0], "old");
+    ch_hash_put(hash, keys[1], "old");
+    snap = ch_hash_snapshot(hash);
+
+    // Overwrite a key and insert a new one, in the same bucket
+    ch_hash_put(hash, keys[0], "new");
+    ch_hash_put(hash, keys[2], "new");
+
+    assert(2 == snap->size);
+    assert(0 == strcmp("old", ch_snapshot_get(snap, keys[0])));
+    assert(0 == strcmp("old", ch_snapshot_get(snap, keys[1])));
+    assert(!ch_snapshot_contains(snap, keys[2]));
+
+    assert(3 == hash->size);
+    assert(0 == strcmp("new", ch_hash_get(hash, keys[0])));
+    assert(0 == strcmp("old", ch_hash_get(hash, keys[1])));
+    assert(0 == strcmp("new", ch_hash_get(hash, keys[2])));
+
+    ch_snapshot_release(snap);
+    ch_hash_free(hash);
+}
+
+// Puts the keys [from, to) with the given value
+static void put_range(ch_hash *hash, int from, int to, const char *val) {
+    char key[32];
+    for(int i = from; i < to; i++) {
+        sprintf(key, "k%d", i);
+        ch_hash_put(hash, key, val);
+    }
+}
+
+// Checks that the keys [from, to) have the given value (or are missing if NULL)
+static void check_range(ch_snapshot *snap, int from, int to, const char *val) {
+    char key[32];
+    for(int i = from; i < to; i++) {
+        sprintf(key, "k%d", i);
+        if (NULL == val) {
+            assert(!ch_snapshot_contains(snap, key));
+        }
+        else {
+            assert(0 == strcmp(val, ch_snapshot_get(snap, key)));
+        }
+    }
+}
+
+// Several snapshots taken between writes each keep their own view,
+// including across grows of the table
+static void test_snapshot_multiple(void) {
+    ch_hash *hash = new_string_hash();
+    ch_snapshot *snaps[5];
+
+    put_range(hash, 0, 20, "a");
+    snaps[0] = ch_hash_snapshot(hash);
+    put_range(hash, 0, 10, "b");
+    snaps[1] = ch_hash_snapshot(hash);
+    // Nothing changed, the same view
+    snaps[2] = ch_hash_snapshot(hash);
+    put_range(hash, 5, 15, "c");
+    // Grows the table
+    put_range(hash, 20, 200, "d");
+    snaps[3] = ch_hash_snapshot(hash);
+    put_range(hash, 0, 200, "e");
+    put_range(hash, 200, 1000, "f");
+    snaps[4] = ch_hash_snapshot(hash);
+    put_range(hash, 0, 1000, "g");
+
+    check_range(snaps[0], 0, 20, "a");
+    check_range(snaps[0], 20, 1000, NULL);
+    assert(20 == snaps[0]->size);
+
+    for(int i = 1; i < 3; i++) {
+        check_range(snaps[i], 0, 10, "b");
+        check_range(snaps[i], 10, 20, "a");
+        check_range(snaps[i], 20, 1000, NULL);
+        assert(20 == snaps[i]->size);
+    }
+
+    check_range(snaps[3], 0, 5, "b");
+    check_range(snaps[3], 5, 15, "c");
+    check_range(snaps[3], 15, 20, "a");
+    check_range(snaps[3], 20, 200, "d");
+    check_range(snaps[3], 200, 1000, NULL);
+    assert(200 == snaps[3]->size);
+
+    check_range(snaps[4], 0, 200, "e");
+    check_range(snaps[4], 200, 1000, "f");
+    assert(1000 == snaps[4]->size);
+
+    for(int i = 0; i < 5; i++) {
+        ch_snapshot_release(snaps[i]);
+    }
+    ch_hash_free(hash);
+}
+
+// Snapshots can be released in any order, before or after the table
+// (leaks are reported when built with -fsanitize=address)
+static void test_snapshot_release_order(void) {
+    int orders[][4] = {
+        { 0, 1, 2, -1 },    // -1 frees the table
+        { 2, 1, 0, -1 },
+        { -1, 0, 1, 2 },
+        { -1, 2, 1, 0 },
+        { 1, -1, 0, 2 },
+        { 0, -1, 2, 1 },
+    };
+    ch_hash *hash;
+    ch_snapshot *snaps[3];
+
+    for(int o = 0; o < sizeof(orders) / sizeof(orders[0]); o++) {
+        hash = new_string_hash();
+        put_range(hash, 0, 20, "a");
+        snaps[0] = ch_hash_snapshot(hash);
+        put_range(hash, 10, 30, "b");
+        snaps[1] = ch_hash_snapshot(hash);
+        // Grows the table
+        put_range(hash, 0, 100, "c");
+        snaps[2] = ch_hash_snapshot(hash);
+        put_range(hash, 50, 60, "d");
+
+        for(int i = 0; i < 4; i++) {
+            if (-1 == orders[o][i]) {
+                ch_hash_free(hash);
+                continue;
+            }
+            ch_snapshot_release(snaps[orders[o][i]]);
+            // The remaining snapshots are unchanged
+            for(int j = i + 1; j < 4; j++) {
+                switch(orders[o][j]) {
+                    case 0:
+                        check_range(snaps[0], 0, 20, "a");
+                        break;
+                    case 1:
+                        check_range(snaps[1], 0, 10, "a");
+                        check_range(snaps[1], 10, 30, "b");
+                        break;
+                    case 2:
+                        check_range(snaps[2], 0, 50, "c");
+                        check_range(snaps[2], 50, 60, "c");
+                        break;
+                }
+            }
+        }
+    }
+}
+
+// Set operations must accept NULL values, from the tables or from resolve
+static void test_set_operations_null_value(void) {
+    ch_hash *a = new_string_hash();
+    ch_hash *b = new_string_hash();
+    ch_hash *empty = new_string_hash();
+    ch_hash *result;
+
+    ch_hash_put(a, "x", "1");
+    ch_hash_put(a, "x", NULL);
+    ch_hash_put(a, "y", "1");
+    ch_hash_put(b, "y", "2");
+
+    result = ch_hash_difference(a, empty);
+    assert(2 == result->size);
+    assert(ch_hash_contains(result, "x"));
+    assert(NULL == ch_hash_get(result, "x"));
+    ch_hash_free(result);
+
+    result = ch_hash_intersect(empty, a);
+    assert(0 == result->size);
+    ch_hash_free(result);
+
+    result = ch_hash_merge(a, b, resolve_null, NULL);
+    assert(2 == result->size);
+    assert(NULL == ch_hash_get(result, "x"));
+    assert(ch_hash_contains(result, "y"));
+    assert(NULL == ch_hash_get(result, "y"));
+    ch_hash_free(result);
+
+    result = ch_hash_merge(a, b, NULL, NULL);
+    assert(0 == strcmp("2", ch_hash_get(result, "y")));
+    ch_hash_free(result);
+
+    ch_hash_free(a);
+    ch_hash_free(b);
+    ch_hash_free(empty);
+}
+
+// Puts 4 keys in the same bucket: the last one put is the first of the chain
+static ch_hash *new_reorder_hash(char keys[][16], ch_reorder mode, uint32_t rate) {
+    ch_hash *hash = new_string_hash();
+    same_bucket_keys(hash->capacity, keys, 4);
+    for(int i = 0; i < 4; i++) {
+        ch_hash_put(hash, keys[i], keys[i]);
+    }
+    for(int i = 0; i < 4; i++) {
+        assert(4 - i == ch_hash_depth(hash, keys[i]));
+    }
+    ch_hash_set_reorder(hash, mode, rate);
+    return hash;
+}
+
+static void test_reorder_move_to_front(void) {
+    char keys[4][16];
+    ch_hash *hash = new_reorder_hash(keys, CH_REORDER_MOVE_TO_FRONT, 1);
+
+    assert(0 == strcmp(keys[0], ch_hash_get(hash, keys[0])));
+    assert(1 == ch_hash_depth(hash, keys[0]));
+    assert(2 == ch_hash_depth(hash, keys[3]));
+    assert(ch_hash_contains(hash, keys[1]));
+    assert(1 == ch_hash_depth(hash, keys[1]));
+    assert(0 == ch_hash_depth(hash, "missing"));
+
+    ch_hash_free(hash);
+}
+
+static void test_reorder_transpose(void) {
+    char keys[4][16];
+    ch_hash *hash = new_reorder_hash(keys, CH_REORDER_TRANSPOSE, 1);
+
+    assert(0 == strcmp(keys[0], ch_hash_get(hash, keys[0])));
+    assert(3 == ch_hash_depth(hash, keys[0]));
+    assert(4 == ch_hash_depth(hash, keys[1]));
+    assert(ch_hash_contains(hash, keys[0]));
+    assert(2 == ch_hash_depth(hash, keys[0]));
+    // The first of the chain stays in place
+    assert(ch_hash_contains(hash, keys[3]));
+    assert(1 == ch_hash_depth(hash, keys[3]));
+
+    ch_hash_free(hash);
+}
+
+// Whatever the state of the (per thread) counter, 2 * rate hits reorder twice
+static void test_reorder_rate(void) {
+    char keys[4][16];
+    ch_hash *hash = new_reorder_hash(keys, CH_REORDER_TRANSPOSE, 3);
+
+    for(int i = 0; i < 6; i++) {
+        assert(ch_hash_contains(hash, keys[0]));
+    }
+    assert(2 == ch_hash_depth(hash, keys[0]));
+
+    ch_hash_free(hash);
+}
+
+static void test_reorder_keeps_keys(void) {
+    ch_reorder modes[] = { CH_REORDER_MOVE_TO_FRONT, CH_REORDER_TRANSPOSE };
+    ch_hash *hash;
+    char key[32];
+
+    for(int m = 0; m < 2; m++) {
+        hash = new_string_hash();
+        ch_hash_set_reorder(hash, modes[m], 2);
+        for(int i = 0; i < 2000; i++) {
+            sprintf(key, "k%d", i);
+            ch_hash_put(hash, key, key);
+            // Lookups of older keys, while the table grows
+            sprintf(key, "k%d", (i * 7) % (i + 1));
+            assert(ch_hash_contains(hash, key));
+        }
+        for(int i = 0; i < 20000; i++) {
+            sprintf(key, "k%d", (i * 31) % 2000);
+            assert(0 == strcmp(key, ch_hash_get(hash, key)));
+        }
+        assert(2000 == hash->size);
+        for(int i = 0; i < 2000; i++) {
+            sprintf(key, "k%d", i);
+            assert(0 == strcmp(key, ch_hash_get(hash, key)));
+        }
+        ch_hash_free(hash);
+    }
+}
+
+// A chain shared with a snapshot is not reordered by lookups on the table
+static void test_reorder_shared_chain(void) {
+    char keys[4][16];
+    ch_hash *hash = new_reorder_hash(keys, CH_REORDER_MOVE_TO_FRONT, 1);
+    ch_snapshot *snap = ch_hash_snapshot(hash);
+
+    assert(0 == strcmp(keys[0], ch_hash_get(hash, keys[0])));
+    assert(4 == ch_hash_depth(hash, keys[0]));
+    for(int i = 0; i < 4; i++) {
+        assert(0 == strcmp(keys[i], ch_snapshot_get(snap, keys[i])));
+    }
+
+    ch_snapshot_release(snap);
+    ch_hash_free(hash);
+}
+
+static void test_filter_grow(void) {
+    ch_hash *hash = new_string_hash();
+
+    ch_hash_set_filter(hash, true);
+    // Grows the table several times
+    put_range(hash, 0, 5000, "a");
+    assert(hash->capacity > CH_HASH_CAPACITY_INIT * 64);
+    check_hash_range(hash, 0, 5000, "a");
+    check_hash_range(hash, 5000, 6000, NULL);
+
+    ch_hash_free(hash);
+}
+
+static void test_filter_rebuild(void) {
+    ch_hash *hash = new_string_hash();
+
+    ch_hash_set_filter(hash, true);
+    put_range(hash, 0, 100, "a");
+    ch_hash_set_filter(hash, false);
+    assert(NULL == hash->filter);
+    // Put while the filter is disabled
+    put_range(hash, 100, 1000, "b");
+    ch_hash_set_filter(hash, true);
+    assert(NULL != hash->filter);
+
+    check_hash_range(hash, 0, 100, "a");
+    check_hash_range(hash, 100, 1000, "b");
+    check_hash_range(hash, 1000, 2000, NULL);
+
+    ch_hash_free(hash);
+}
+
+// A grow copying the chains shared with a snapshot adds them to the filter
+static void test_filter_grow_snapshot(void) {
+    ch_hash *hash = new_string_hash();
+    ch_snapshot *snap;
+
+    ch_hash_set_filter(hash, true);
+    put_range(hash, 0, 30, "a");
+    snap = ch_hash_snapshot(hash);
+    // Grows the table while all the old chains are shared
+    put_range(hash, 30, 100, "b");
+
+    check_hash_range(hash, 0, 30, "a");
+    check_hash_range(hash, 30, 100, "b");
+    check_range(snap, 0, 30, "a");
+    check_range(snap, 30, 100, NULL);
+
+    ch_snapshot_release(snap);
+    ch_hash_free(hash);
+}
+
+// Set operations give the same results when h2 has a filter
+static void test_filter_set_operations(void) {
+    ch_hash *h1 = new_range_hash(0, 100, "h1");
+    ch_hash *h2 = new_range_hash(50, 150, "h2");
+    ch_hash *result;
+
+    ch_hash_set_filter(h2, true);
+
+    result = ch_hash_merge(h1, h2, NULL, NULL);
+    assert(150 == result->size);
+    check_hash_range(result, 0, 50, "h1");
+    check_hash_range(result, 50, 150, "h2");
+    ch_hash_free(result);
+
+    result = ch_hash_intersect(h1, h2);
+    assert(50 == result->size);
+    check_hash_range(result, 50, 100, "h1");
+    ch_hash_free(result);
+
+    result = ch_hash_difference(h1, h2);
+    assert(50 == result->size);
+    check_hash_range(result, 0, 50, "h1");
+    check_hash_range(result, 50, 150, NULL);
+    ch_hash_free(result);
+
+    ch_hash_free(h1);
+    ch_hash_free(h2);
+}
+
+int main(void) {
+    test_snapshot_null_value();
+    test_snapshot_null_value_grow();
+    test_snapshot_isolation();
+    test_snapshot_multiple();
+    test_snapshot_release_order();
+    test_set_operations_null_value();
+    test_merge();
+    test_intersect();
+    test_difference();
+    test_filter_grow();
+    test_filter_rebuild();
+    test_filter_grow_snapshot();
+    test_filter_set_operations();
+    test_reorder_move_to_front();
+    test_reorder_transpose();
+    test_reorder_rate();
+    test_reorder_keeps_keys();
+    test_reorder_shared_chain();
+    printf("All tests passed.\n");
+    return 0;
+}
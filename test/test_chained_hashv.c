@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../chained_hashv.h"
+
+static ch_hashv *new_string_hashv(void) {
+    return ch_hashv_new(ch_key_ops_string, ch_val_ops_string);
+}
+
+// Fills `keys` with `n` keys falling into the same bucket of a table
+// with the given capacity
+static void same_bucket_keys(size_t capacity, char keys[][16], int n) {
+    char key[16];
+    size_t bucket_idx = 0;
+    int found = 0;
+    for(int i = 0; found < n; i++) {
+        sprintf(key, "b%d", i);
+        if (0 == found) {
+            bucket_idx = ch_string_hash(key, NULL) % capacity;
+        }
+        if (ch_string_hash(key, NULL) % capacity == bucket_idx) {
+            strcpy(keys[found++], key);
+        }
+    }
+}
+
+// Puts 4 keys in the same bucket: the first one put is the first of the bucket
+static ch_hashv *new_reorder_hashv(char keys[][16], ch_reorder mode, uint32_t rate) {
+    ch_hashv *htable = new_string_hashv();
+    same_bucket_keys(htable->capacity, keys, 4);
+    for(int i = 0; i < 4; i++) {
+        ch_hashv_put(htable, keys[i], keys[i]);
+    }
+    for(int i = 0; i < 4; i++) {
+        assert(i + 1 == ch_hashv_depth(htable, keys[i]));
+    }
+    ch_hashv_set_reorder(htable, mode, rate);
+    return htable;
+}
+
+static void test_reorder_move_to_front(void) {
+    char keys[4][16];
+    ch_hashv *htable = new_reorder_hashv(keys, CH_REORDER_MOVE_TO_FRONT, 1);
+
+    assert(0 == strcmp(keys[3], ch_hashv_get(htable, keys[3])));
+    assert(1 == ch_hashv_depth(htable, keys[3]));
+    assert(2 == ch_hashv_depth(htable, keys[0]));
+    assert(4 == ch_hashv_depth(htable, keys[2]));
+    assert(ch_hashv_contains(htable, keys[2]));
+    assert(1 == ch_hashv_depth(htable, keys[2]));
+    assert(0 == ch_hashv_depth(htable, "missing"));
+
+    ch_hashv_free(htable);
+}
+
+static void test_reorder_transpose(void) {
+    char keys[4][16];
+    ch_hashv *htable = new_reorder_hashv(keys, CH_REORDER_TRANSPOSE, 1);
+
+    assert(0 == strcmp(keys[3], ch_hashv_get(htable, keys[3])));
+    assert(3 == ch_hashv_depth(htable, keys[3]));
+    assert(4 == ch_hashv_depth(htable, keys[2]));
+    assert(ch_hashv_contains(htable, keys[3]));
+    assert(2 == ch_hashv_depth(htable, keys[3]));
+    // The first of the bucket stays in place
+    assert(ch_hashv_contains(htable, keys[0]));
+    assert(1 == ch_hashv_depth(htable, keys[0]));
+
+    ch_hashv_free(htable);
+}
+
+// Whatever the state of the (per thread) counter, 2 * rate hits reorder twice
+static void test_reorder_rate(void) {
+    char keys[4][16];
+    ch_hashv *htable = new_reorder_hashv(keys, CH_REORDER_TRANSPOSE, 3);
+
+    for(int i = 0; i < 6; i++) {
+        assert(ch_hashv_contains(htable, keys[3]));
+    }
+    assert(2 == ch_hashv_depth(htable, keys[3]));
+
+    ch_hashv_free(htable);
+}
+
+static void test_reorder_keeps_keys(void) {
+    ch_reorder modes[] = { CH_REORDER_MOVE_TO_FRONT, CH_REORDER_TRANSPOSE };
+    ch_hashv *htable;
+    char key[32];
+
+    for(int m = 0; m < 2; m++) {
+        htable = new_string_hashv();
+        ch_hashv_set_reorder(htable, modes[m], 2);
+        for(int i = 0; i < 5000; i++) {
+            sprintf(key, "k%d", i);
+            ch_hashv_put(htable, key, key);
+            // Lookups of older keys, while the table grows
+            sprintf(key, "k%d", (i * 7) % (i + 1));
+            assert(ch_hashv_contains(htable, key));
+        }
+        for(int i = 0; i < 50000; i++) {
+            sprintf(key, "k%d", (i * 31) % 5000);
+            assert(0 == strcmp(key, ch_hashv_get(htable, key)));
+        }
+        assert(5000 == htable->size);
+        for(int i = 0; i < 5000; i++) {
+            sprintf(key, "k%d", i);
+            assert(0 == strcmp(key, ch_hashv_get(htable, key)));
+        }
+        ch_hashv_free(htable);
+    }
+}
+
+int main(void) {
+    test_reorder_move_to_front();
+    test_reorder_transpose();
+    test_reorder_rate();
+    test_reorder_keeps_keys();
+    printf("All tests passed.\n");
+    return 0;
+}
@@ -1,3 +1,6 @@
+#ifndef VECT_H
+#define VECT_H
+
 #include <stddef.h>
 
 #define VECT_INIT_CAPACITY (32)
@@ -14,4 +17,6 @@ ch_vect* ch_vect_new_default();
 void ch_vect_free(ch_vect *vect);
 void* ch_vect_get(ch_vect *vect, size_t idx);
 void ch_vect_set(ch_vect *vect, size_t idx, void *data);
-void ch_vect_append(ch_vect *vect, void *data);
\ No newline at end of file
+void ch_vect_append(ch_vect *vect, void *data);
+
+#endif